@@ -1,6 +1,15 @@
 #ifndef FUNCTIONS_H
 #define FUNCTIONS_H
 
+/* ================================================================
+   CONSOLE INPUT
+   Buffered replacements for scanf("%d") and the getchar() drain loop;
+   all modules read stdin through the same buffer.
+   ================================================================ */
+int in_read_int(int *out);
+void in_skip_line(void);
+
+
 /* ================================================================
    ASSET INVENTORY MODULE
    Only public menu function exposed.
@@ -25,4 +34,35 @@ void heapSchedulerMenu(void);
    ================================================================ */
 void serverHealthMenu(void);
 
+/* Ingestion daemon for local agents (Unix domain socket) and a load
+   generator that drives it; both return a process exit status. */
+int healthDaemon(const char *socket_path);
+int healthLoadGen(const char *socket_path, int clients, int seconds);
+
+/* ================================================================
+   SHARED STATE
+   Keep the asset store and the health report ring in a file mapped
+   by every process that attaches to it, so concurrent sessions see
+   each other's changes. Returns 0, or -1 after printing why not.
+   ================================================================ */
+int sharedStateAttach(const char *path);
+
+/* ================================================================
+   WORKLOAD RECORD AND REPLAY
+   traceRecord logs this session's console input and menu actions
+   to a binary trace; traceReplay feeds a trace back in place of
+   stdin (paced = keep the recorded timing) and prints per-action
+   latencies at exit. Both return 0, or -1 after printing why not.
+   ================================================================ */
+int traceRecord(const char *path);
+int traceReplay(const char *path, int paced);
+
+/* ================================================================
+   OPERATION STATISTICS
+   Per-thread counters and latency histograms of the hot operations,
+   printed as one line of JSON (on stderr when SIGUSR1 arrives).
+   ================================================================ */
+void opStatsInit(void);
+void opStatsDump(void);
+
 #endif // FUNCTIONS_H
@@ -1,7 +1,12 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "functions.h"
 
+#define HEALTH_SOCKET "health.sock"
+#define SHARED_STATE "shared.state"
+#define SESSION_TRACE "session.trace"
+
 /* Type definition must match functions.c */
 typedef enum {
     ROLE_NONE = 0,
@@ -29,8 +34,8 @@ UserRole selectRole(void) {
     printf("=================================\n");
     printf("Enter your choice: ");
     
-    if (scanf("%d", &choice) != 1) {
-        while (getchar() != '\n');
+    if (in_read_int(&choice) != 1) {
+        in_skip_line();
         return ROLE_NONE;
     }
     
@@ -50,8 +55,34 @@ UserRole selectRole(void) {
     }
 }
 
-int main(void) {
+int main(int argc, char **argv) {
     int choice;
+
+    opStatsInit();
+
+    /* Non-interactive modes:
+         --health-daemon  [socket]
+         --health-loadgen [socket] [clients] [seconds]
+       and the interactive menus on state shared with other processes,
+       recorded, or replayed from a recording:
+         --shared [file]
+         --record [trace]
+         --replay [trace] [--paced] */
+    if (argc > 1 && strcmp(argv[1], "--health-daemon") == 0)
+        return healthDaemon(argc > 2 ? argv[2] : HEALTH_SOCKET);
+    if (argc > 1 && strcmp(argv[1], "--health-loadgen") == 0)
+        return healthLoadGen(argc > 2 ? argv[2] : HEALTH_SOCKET,
+                             argc > 3 ? atoi(argv[3]) : 8,
+                             argc > 4 ? atoi(argv[4]) : 5);
+    if (argc > 1 && strcmp(argv[1], "--shared") == 0 &&
+        sharedStateAttach(argc > 2 ? argv[2] : SHARED_STATE) != 0)
+        return 1;
+    if (argc > 1 && strcmp(argv[1], "--record") == 0 &&
+        traceRecord(argc > 2 ? argv[2] : SESSION_TRACE) != 0)
+        return 1;
+    if (argc > 1 && strcmp(argv[1], "--replay") == 0 &&
+        traceReplay(argc > 2 ? argv[2] : SESSION_TRACE, argc > 3 && strcmp(argv[3], "--paced") == 0) != 0)
+        return 1;
     
     // First, select role
     while (1) {
@@ -74,11 +105,12 @@ int main(void) {
             printf("3. Heap Manager\n");
             printf("4. Server Health\n");
             printf("5. Change Role\n");
-            printf("6. Exit\n");
+            printf("6. Operation Statistics (JSON)\n");
+            printf("7. Exit\n");
             printf("Enter your choice: ");
             
-            if (scanf("%d", &choice) != 1) { 
-                while (getchar() != '\n'); 
+            if (in_read_int(&choice) != 1) { 
+                in_skip_line(); 
                 continue; 
             }
             
@@ -93,7 +125,8 @@ int main(void) {
                 case 2: bstLoadManagerMenu(); break;
                 case 3: heapSchedulerMenu(); break;
                 case 4: serverHealthMenu(); break;
-                case 6: printf("Bye!\n"); return 0;
+                case 6: opStatsDump(); break;
+                case 7: printf("Bye!\n"); return 0;
                 default: printf("Invalid choice.\n");
             }
         }